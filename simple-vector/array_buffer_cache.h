@@ -0,0 +1,233 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+// Ограничения кэша освобождённых буферов
+struct ArrayBufferCacheLimits {
+    // Максимальный объём памяти, хранящейся в одном размерном классе
+    size_t max_bytes_per_class = size_t(8) << 20;
+    // Максимальный суммарный объём памяти, хранящейся в кэше одного потока
+    size_t max_total_bytes = size_t(32) << 20;
+};
+
+// Статистика кэша текущего потока
+struct ArrayBufferCacheStats {
+    // Выделения, обслуженные повторно использованным буфером из кэша
+    size_t hits = 0;
+    // Выделения, для которых пришлось обратиться к operator new
+    size_t misses = 0;
+    // Количество и суммарный размер буферов, лежащих в кэше в данный момент
+    size_t cached_blocks = 0;
+    size_t cached_bytes = 0;
+};
+
+// Потоколокальный кэш освобождённых буферов, которым пользуется ArrayPtr.
+// Буферы группируются по размерным классам от 16 байт до 1 ГиБ: каждый интервал между
+// соседними степенями двойки делится на 4 класса. Запрошенный размер округляется вверх
+// до размера класса, поэтому буфер может быть больше запрошенного не более чем на 25%,
+// и ограничения кэша учитывают именно размер класса.
+// По умолчанию кэш выключен. Включение и ограничения общие для всех потоков,
+// а сами буферы и статистика у каждого потока свои
+class ArrayBufferCache {
+public:
+    ArrayBufferCache() = delete;
+
+    static void SetEnabled(bool enabled) noexcept {
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool IsEnabled() noexcept {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // Новые ограничения применяются при следующих освобождениях памяти.
+    // Уже лежащие в кэше буферы не выбрасываются, для этого служит Trim
+    static void SetLimits(const ArrayBufferCacheLimits& limits) noexcept {
+        max_bytes_per_class_.store(limits.max_bytes_per_class, std::memory_order_relaxed);
+        max_total_bytes_.store(limits.max_total_bytes, std::memory_order_relaxed);
+    }
+
+    static ArrayBufferCacheLimits GetLimits() noexcept {
+        ArrayBufferCacheLimits limits;
+        limits.max_bytes_per_class = max_bytes_per_class_.load(std::memory_order_relaxed);
+        limits.max_total_bytes = max_total_bytes_.load(std::memory_order_relaxed);
+        return limits;
+    }
+
+    // Возвращает статистику кэша текущего потока
+    static ArrayBufferCacheStats GetStats() noexcept {
+        ThreadCache* cache = Local();
+        return cache == nullptr ? ArrayBufferCacheStats{} : cache->stats;
+    }
+
+    // Обнуляет счётчики попаданий и промахов текущего потока
+    static void ResetStats() noexcept {
+        if (ThreadCache* cache = Local()) {
+            cache->stats.hits = 0;
+            cache->stats.misses = 0;
+        }
+    }
+
+    // Возвращает память из кэша текущего потока системе, пока в нём не останется
+    // не более max_cached_bytes байт. Первыми освобождаются самые крупные буферы
+    static void Trim(size_t max_cached_bytes = 0) noexcept {
+        if (ThreadCache* cache = Local()) {
+            cache->Trim(max_cached_bytes);
+        }
+    }
+
+    // Выделяет буфер размером не менее bytes байт
+    static void* Allocate(size_t bytes) {
+        ThreadCache* cache = Local();
+        if (bytes > kMaxBlockBytes) {
+            if (cache != nullptr) {
+                ++cache->stats.misses;
+            }
+            return ::operator new(bytes);
+        }
+
+        const size_t index = ClassIndex(bytes);
+        if (cache != nullptr) {
+            if (void* block = cache->Pop(index)) {
+                ++cache->stats.hits;
+                return block;
+            }
+            ++cache->stats.misses;
+        }
+        return ::operator new(ClassBytes(index));
+    }
+
+    // Освобождает буфер, полученный от Allocate с тем же значением bytes.
+    // Если кэш включён и позволяют ограничения, буфер остаётся в кэше текущего потока
+    static void Deallocate(void* ptr, size_t bytes) noexcept {
+        if (ptr == nullptr) {
+            return;
+        }
+        if (bytes <= kMaxBlockBytes && IsEnabled()) {
+            ThreadCache* cache = Local();
+            if (cache != nullptr && cache->Push(ClassIndex(bytes), ptr)) {
+                return;
+            }
+        }
+        ::operator delete(ptr);
+    }
+
+private:
+    static constexpr size_t kMinClassShift = 4;
+    static constexpr size_t kMaxClassShift = 30;
+    static constexpr size_t kMinBlockBytes = size_t(1) << kMinClassShift;
+    static constexpr size_t kMaxBlockBytes = size_t(1) << kMaxClassShift;
+    static constexpr size_t kClassesPerShift = 4;
+    static constexpr size_t kClassCount = (kMaxClassShift - kMinClassShift) * kClassesPerShift + 1;
+
+    // Освобождённый буфер хранит в себе указатель на следующий буфер своего класса
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Bucket {
+        FreeBlock* head = nullptr;
+        size_t blocks = 0;
+    };
+
+    struct ThreadCache {
+        std::array<Bucket, kClassCount> buckets;
+        ArrayBufferCacheStats stats;
+
+        ThreadCache() = default;
+        ThreadCache(const ThreadCache&) = delete;
+        ThreadCache& operator=(const ThreadCache&) = delete;
+
+        ~ThreadCache() {
+            Trim(0);
+            thread_cache_destroyed_ = true;
+        }
+
+        void* Pop(size_t index) noexcept {
+            Bucket& bucket = buckets[index];
+            FreeBlock* block = bucket.head;
+            if (block == nullptr) {
+                return nullptr;
+            }
+            bucket.head = block->next;
+            --bucket.blocks;
+            --stats.cached_blocks;
+            stats.cached_bytes -= ClassBytes(index);
+            return block;
+        }
+
+        bool Push(size_t index, void* ptr) noexcept {
+            const size_t block_bytes = ClassBytes(index);
+            Bucket& bucket = buckets[index];
+            if ((bucket.blocks + 1) * block_bytes > max_bytes_per_class_.load(std::memory_order_relaxed)
+                || stats.cached_bytes + block_bytes > max_total_bytes_.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            bucket.head = ::new (ptr) FreeBlock{bucket.head};
+            ++bucket.blocks;
+            ++stats.cached_blocks;
+            stats.cached_bytes += block_bytes;
+            return true;
+        }
+
+        void Trim(size_t max_cached_bytes) noexcept {
+            for (size_t index = kClassCount; index-- > 0;) {
+                while (stats.cached_bytes > max_cached_bytes) {
+                    void* block = Pop(index);
+                    if (block == nullptr) {
+                        break;
+                    }
+                    ::operator delete(block);
+                }
+            }
+        }
+    };
+
+    // Номер размерного класса: наименьший класс, вмещающий bytes байт.
+    // Класс 0 - блоки до 16 байт, далее интервал (2^k, 2^(k+1)] делится на 4 равных шага
+    static size_t ClassIndex(size_t bytes) noexcept {
+        if (bytes <= kMinBlockBytes) {
+            return 0;
+        }
+        // Номер старшего бита bytes - 1, то есть такое k, что 2^k < bytes <= 2^(k+1)
+#if defined(__GNUC__) || defined(__clang__)
+        const size_t shift = 63 - __builtin_clzll(static_cast<unsigned long long>(bytes - 1));
+#else
+        size_t shift = kMinClassShift;
+        while ((size_t(2) << shift) < bytes) {
+            ++shift;
+        }
+#endif
+        const size_t step = (size_t(1) << shift) / kClassesPerShift;
+        const size_t sub = (bytes - (size_t(1) << shift) + step - 1) / step;
+        return (shift - kMinClassShift) * kClassesPerShift + sub;
+    }
+
+    // Размер блока в байтах для класса с номером index
+    static size_t ClassBytes(size_t index) noexcept {
+        if (index == 0) {
+            return kMinBlockBytes;
+        }
+        const size_t shift = (index - 1) / kClassesPerShift + kMinClassShift;
+        const size_t sub = (index - 1) % kClassesPerShift + 1;
+        return (size_t(1) << shift) + sub * ((size_t(1) << shift) / kClassesPerShift);
+    }
+
+    // Возвращает кэш текущего потока либо nullptr, если он уже разрушен
+    // (например, при освобождении памяти из деструкторов других thread_local объектов)
+    static ThreadCache* Local() noexcept {
+        if (thread_cache_destroyed_) {
+            return nullptr;
+        }
+        thread_local ThreadCache cache;
+        return &cache;
+    }
+
+    static inline std::atomic<bool> enabled_{false};
+    static inline std::atomic<size_t> max_bytes_per_class_{ArrayBufferCacheLimits{}.max_bytes_per_class};
+    static inline std::atomic<size_t> max_total_bytes_{ArrayBufferCacheLimits{}.max_total_bytes};
+    static inline thread_local bool thread_cache_destroyed_ = false;
+};
@@ -1,6 +1,13 @@
 #pragma once
 
+#include "array_buffer_cache.h"
+
+#include <algorithm>
 #include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
 
 template <typename Type>
 class ArrayPtr {
@@ -10,8 +17,19 @@ public:
 
     // Создаёт в куче массив из size элементов типа Type.
     // Если size == 0, поле raw_ptr_ должно быть равно nullptr
+    // При включённом ArrayBufferCache память по возможности берётся из кэша текущего потока
     explicit ArrayPtr(size_t size) {
-        raw_ptr_ = (size == 0 ? nullptr : new Type[size]{});
+        if (size == 0) {
+            return;
+        }
+        if constexpr (alignof(Type) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            if (ArrayBufferCache::IsEnabled()) {
+                raw_ptr_ = AllocateCached(size);
+                cached_size_ = size;
+                return;
+            }
+        }
+        raw_ptr_ = new Type[size]{};
     }
 
     // Конструктор из сырого указателя, хранящего адрес массива в куче либо nullptr
@@ -23,22 +41,22 @@ public:
     ArrayPtr(const ArrayPtr&) = delete;
 
     ArrayPtr(ArrayPtr&& other)
-            : raw_ptr_(other.raw_ptr_)
+            : raw_ptr_(std::exchange(other.raw_ptr_, nullptr))
+            , cached_size_(std::exchange(other.cached_size_, 0))
     {
-        other.raw_ptr_ = nullptr;
     }
 
     ArrayPtr& operator=(ArrayPtr&& other) {
-        Type* tmp = raw_ptr_;
-        raw_ptr_ = other.raw_ptr_;
-        other.raw_ptr_ = nullptr;
-        delete[] tmp;
+        if (this != &other) {
+            Free();
+            raw_ptr_ = std::exchange(other.raw_ptr_, nullptr);
+            cached_size_ = std::exchange(other.cached_size_, 0);
+        }
         return *this;
     }
 
     ~ArrayPtr() {
-        delete[] raw_ptr_;
-        raw_ptr_ = nullptr;
+        Free();
     }
 
     // Запрещаем присваивание
@@ -46,7 +64,16 @@ public:
 
     // Прекращает владением массивом в памяти, возвращает значение адреса массива
     // После вызова метода указатель на массив должен обнулиться
-    [[nodiscard]] Type* Release() noexcept {
+    // Возвращённый массив всегда освобождается через delete[]: массив, взятый из
+    // ArrayBufferCache, перед этим перемещается в память, выделенную new[].
+    // Если перемещение элемента выбросит исключение, ArrayPtr продолжит владеть исходным массивом
+    [[nodiscard]] Type* Release() {
+        if (cached_size_ != 0) {
+            std::unique_ptr<Type[]> tmp(new Type[cached_size_]{});
+            std::move(raw_ptr_, raw_ptr_ + cached_size_, tmp.get());
+            Free();
+            return tmp.release();
+        }
         Type* tmp = raw_ptr_;
         raw_ptr_ = nullptr;
         return tmp;
@@ -74,12 +101,41 @@ public:
 
     // Обменивается значениям указателя на массив с объектом other
     void swap(ArrayPtr& other) noexcept {
-        Type* tmp = other.raw_ptr_;
-        other.raw_ptr_ = raw_ptr_;
-        raw_ptr_ = tmp;
-        tmp = nullptr;
+        std::swap(raw_ptr_, other.raw_ptr_);
+        std::swap(cached_size_, other.cached_size_);
     }
 
 private:
+    // Выделяет в ArrayBufferCache память под size элементов и инициализирует их значением по умолчанию
+    static Type* AllocateCached(size_t size) {
+        if (size > std::numeric_limits<size_t>::max() / sizeof(Type)) {
+            throw std::bad_array_new_length();
+        }
+        Type* ptr = static_cast<Type*>(ArrayBufferCache::Allocate(size * sizeof(Type)));
+        try {
+            std::uninitialized_value_construct_n(ptr, size);
+        } catch (...) {
+            ArrayBufferCache::Deallocate(ptr, size * sizeof(Type));
+            throw;
+        }
+        return ptr;
+    }
+
+    // Разрушает массив и освобождает память тем же способом, каким она была выделена
+    void Free() noexcept {
+        if (cached_size_ != 0) {
+            std::destroy_n(raw_ptr_, cached_size_);
+            ArrayBufferCache::Deallocate(raw_ptr_, cached_size_ * sizeof(Type));
+        } else {
+            delete[] raw_ptr_;
+        }
+        raw_ptr_ = nullptr;
+        cached_size_ = 0;
+    }
+
     Type* raw_ptr_ = nullptr;
+    // Количество элементов массива, взятого из ArrayBufferCache; 0 - массив выделен через new[]
+    // По указателю нельзя узнать, как был выделен массив, поэтому это поле есть в каждом ArrayPtr
+    // и увеличивает его (а значит, и SimpleVector) на size_t, даже если кэш не используется
+    size_t cached_size_ = 0;
 };
@@ -0,0 +1,108 @@
+#include "simple_vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Копия GenerateVector из main.cpp: воспроизводит сценарий "создать вектор и выбросить"
+SimpleVector<int> GenerateVector(size_t size) {
+    SimpleVector<int> v(size);
+    iota(v.begin(), v.end(), 1);
+    return v;
+}
+
+// Многократно создаёт и выбрасывает векторы нескольких типичных размеров
+size_t GenerateAndDiscard(size_t iterations) {
+    const size_t sizes[] = {16, 100, 1000, 10000};
+    size_t checksum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        SimpleVector<int> v = GenerateVector(sizes[i % size(sizes)]);
+        checksum += v[v.GetSize() - 1];
+    }
+    return checksum;
+}
+
+// Наполняет вектор через PushBack, проходя через все шаги роста вместимости
+size_t PushBackGrowth(size_t iterations) {
+    size_t checksum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        SimpleVector<string> v;
+        for (size_t j = 0; j < 256; ++j) {
+            v.PushBack(string(1, 'a' + j % 26));
+        }
+        checksum += v.GetCapacity();
+    }
+    return checksum;
+}
+
+// Запускает workload в threads потоках и возвращает время работы в миллисекундах.
+// Время каждого потока фиксируется до очистки его кэша, чтобы освобождение памяти
+// при Trim и при завершении потока не попадало в замер
+template <typename Workload>
+long long Run(Workload workload, size_t iterations, size_t threads) {
+    vector<size_t> checksums(threads);
+    vector<chrono::steady_clock::time_point> finishes(threads);
+    const auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            checksums[t] = workload(iterations);
+            finishes[t] = chrono::steady_clock::now();
+            ArrayBufferCache::Trim();
+        });
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    const auto finish = *max_element(finishes.begin(), finishes.end());
+    if (accumulate(checksums.begin(), checksums.end(), size_t(0)) == 0) {
+        cout << "unexpected checksum"s << endl;
+    }
+    return chrono::duration_cast<chrono::milliseconds>(finish - start).count();
+}
+
+long long Median(vector<long long> times) {
+    sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// Для каждой конфигурации делает прогревочный прогон, затем repeats замеров и выводит медиану.
+// Порядок "без кэша"/"с кэшем" чередуется, чтобы ни одна из конфигураций не шла всегда первой
+template <typename Workload>
+void Benchmark(const string& name, Workload workload, size_t iterations, size_t repeats) {
+    const size_t many_threads = max(2u, thread::hardware_concurrency());
+    for (size_t threads : {size_t(1), many_threads}) {
+        for (bool enabled : {false, true}) {
+            ArrayBufferCache::SetEnabled(enabled);
+            Run(workload, iterations, threads);
+        }
+
+        vector<long long> times[2];
+        for (size_t repeat = 0; repeat < repeats; ++repeat) {
+            for (size_t order = 0; order < 2; ++order) {
+                const bool enabled = (order + repeat) % 2 == 1;
+                ArrayBufferCache::SetEnabled(enabled);
+                times[enabled].push_back(Run(workload, iterations, threads));
+            }
+        }
+
+        for (bool enabled : {false, true}) {
+            cout << name << ", threads: "s << threads
+                 << ", cache: "s << (enabled ? "on"s : "off"s)
+                 << ", median time: "s << Median(times[enabled]) << " ms"s << endl;
+        }
+    }
+    ArrayBufferCache::SetEnabled(false);
+}
+
+int main() {
+    Benchmark("GenerateVector and discard"s, GenerateAndDiscard, 200000, 7);
+    Benchmark("PushBack growth"s, PushBackGrowth, 20000, 7);
+    return 0;
+}
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <iostream>
 #include <numeric>
+#include <stdexcept>
 #include <string>
 
 using namespace std;
@@ -32,6 +33,14 @@ private:
     size_t x_;
 };
 
+// Тип, перемещающее присваивание которого всегда выбрасывает исключение
+struct ThrowingMove {
+    ThrowingMove() = default;
+    ThrowingMove& operator=(ThrowingMove&&) {
+        throw runtime_error("move failed"s);
+    }
+};
+
 SimpleVector<int> GenerateVector(size_t size) {
     SimpleVector<int> v(size);
     iota(v.begin(), v.end(), 1);
@@ -150,6 +159,93 @@ void TestNoncopiableErase() {
     cout << "Done!"s << endl << endl;
 }
 
+void TestArrayBufferCache() {
+    cout << "Test array buffer cache"s << endl;
+    ArrayBufferCache::SetEnabled(true);
+    ArrayBufferCache::Trim();
+    ArrayBufferCache::ResetStats();
+
+    const size_t size = 1000;
+    {
+        SimpleVector<int> v = GenerateVector(size);
+        assert(v.GetSize() == size);
+    }
+    assert(ArrayBufferCache::GetStats().misses == 1);
+    assert(ArrayBufferCache::GetStats().cached_blocks == 1);
+
+    // Повторно используемый буфер должен быть проинициализирован заново
+    {
+        SimpleVector<int> v(size);
+        assert(ArrayBufferCache::GetStats().hits == 1);
+        assert(ArrayBufferCache::GetStats().cached_blocks == 0);
+        for (size_t i = 0; i < size; ++i) {
+            assert(v[i] == 0);
+        }
+    }
+
+    // Буферы, выделенные при росте вектора, возвращаются в кэш
+    {
+        SimpleVector<X> v;
+        for (size_t i = 0; i < 16; ++i) {
+            v.PushBack(X(i));
+        }
+        for (size_t i = 0; i < 16; ++i) {
+            assert(v[i].GetX() == i);
+        }
+    }
+    assert(ArrayBufferCache::GetStats().cached_blocks > 1);
+
+    ArrayBufferCache::Trim();
+    assert(ArrayBufferCache::GetStats().cached_blocks == 0);
+    assert(ArrayBufferCache::GetStats().cached_bytes == 0);
+
+    // Буфер, не помещающийся в ограничения, сразу освобождается
+    const ArrayBufferCacheLimits default_limits = ArrayBufferCache::GetLimits();
+    ArrayBufferCacheLimits limits;
+    limits.max_bytes_per_class = 1024;
+    limits.max_total_bytes = 4096;
+    ArrayBufferCache::SetLimits(limits);
+    {
+        SimpleVector<int> v(size);
+    }
+    assert(ArrayBufferCache::GetStats().cached_blocks == 0);
+    {
+        SimpleVector<int> v(size / 8);
+    }
+    assert(ArrayBufferCache::GetStats().cached_blocks == 1);
+
+    ArrayBufferCache::SetLimits(default_limits);
+
+    // Массив, отданный Release, можно передать в ArrayPtr(Type*) и освободить через delete[]
+    {
+        ArrayPtr<string> cached(4);
+        for (size_t i = 0; i < 4; ++i) {
+            cached[i] = to_string(i);
+        }
+        ArrayPtr<string> adopted(cached.Release());
+        assert(!cached);
+        for (size_t i = 0; i < 4; ++i) {
+            assert(adopted[i] == to_string(i));
+        }
+    }
+
+    // Если перемещение элементов в Release выбросит исключение, массив остаётся во владении ArrayPtr
+    {
+        ArrayPtr<ThrowingMove> cached(4);
+        try {
+            ThrowingMove* released = cached.Release();
+            delete[] released;
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        assert(cached);
+    }
+
+    ArrayBufferCache::Trim();
+    ArrayBufferCache::SetEnabled(false);
+    cout << "Done!"s << endl << endl;
+}
+
 int main() {
     TestTemporaryObjConstructor();
     TestTemporaryObjOperator();
@@ -159,5 +255,6 @@ int main() {
     TestNoncopiablePushBack();
     TestNoncopiableInsert();
     TestNoncopiableErase();
+    TestArrayBufferCache();
     return 0;
 }